@@ -2,6 +2,8 @@
 
 #include <array>
 #include <stdexcept>
+#include <mutex>
+#include <asndlib.h>
 #include <mp3player.h>
 
 namespace ff::audio {
@@ -10,13 +12,23 @@ namespace ff::audio {
         Auto = MP3,
     };
 
+    // Initializes ASND and the MP3 player once per process; safe to call from any thread.
+    // ff::sys::Context runs this on a worker thread when ContextParams::Audio is set.
+    inline void init() {
+        static std::once_flag flag{};
+        std::call_once(flag, []() {
+            ASND_Init();
+            MP3Player_Init();
+        });
+    }
+
     template <typename T, std::size_t U>
     class AudioHandler {
         const std::array<T, U>& data;
         AudioFormat format{AudioFormat::Auto};
     public:
         explicit AudioHandler(const std::array<T, U>& data, AudioFormat format = AudioFormat::Auto) : data(data), format(format) {
-            MP3Player_Init();
+            init();
         }
         void play() {
             if (data.empty()) {
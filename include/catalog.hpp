@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// View model for browsing a large catalog. Nothing in here touches GRRLIB, so it builds and runs on the host;
+// drawing is left to the caller through for_each_visible().
+namespace ff::catalog {
+    struct Rect {
+        int x{};
+        int y{};
+        int width{640};
+        int height{480};
+    };
+
+    // half-open range of item indices, [first, last)
+    struct Range {
+        std::size_t first{};
+        std::size_t last{};
+
+        [[nodiscard]] bool contains(std::size_t index) const noexcept {
+            return index >= first && index < last;
+        }
+        [[nodiscard]] std::size_t size() const noexcept {
+            return last - first;
+        }
+        [[nodiscard]] bool empty() const noexcept {
+            return first == last;
+        }
+    };
+
+    struct GridLayout {
+        int item_width{128};
+        int item_height{96};
+        int spacing{8};
+        int columns{0}; // 0 fits as many columns as the viewport allows; 1 makes a list
+        int prefetch_rows{2}; // rows above and below the viewport that are requested ahead of time
+    };
+
+    // Grid that only materializes the items intersecting the viewport.
+    // Row objects are pooled and rebound to new indices as the user scrolls; the pool holds
+    // one screenful, so the work per update() depends on the viewport size, never on the item count.
+    // request is called once when an item enters the prefetch range (visible range plus
+    // GridLayout::prefetch_rows), evict once when it leaves; use them to load and free thumbnails.
+    template <typename Row>
+    class VirtualGrid {
+        static constexpr std::size_t unbound = static_cast<std::size_t>(-1);
+
+        struct Slot {
+            std::size_t index{unbound};
+            Row row{};
+        };
+
+        Rect viewport{};
+        GridLayout layout{};
+        std::size_t count{};
+        int scroll{};
+
+        std::function<void(Row&, std::size_t)> bind{};
+        std::function<void(std::size_t)> request{};
+        std::function<void(std::size_t)> evict{};
+
+        std::vector<Slot> slots{};
+        Range visible{};
+        Range prefetched{};
+
+        [[nodiscard]] int row_pitch() const noexcept {
+            return layout.item_height + layout.spacing;
+        }
+        [[nodiscard]] std::size_t row_count() const noexcept {
+            const auto cols = static_cast<std::size_t>(get_columns());
+            return (count + cols - 1) / cols;
+        }
+
+        void relayout() {
+            if (layout.item_width <= 0 || layout.item_height <= 0 || layout.spacing < 0 || layout.columns < 0 || layout.prefetch_rows < 0) {
+                throw std::runtime_error{"Invalid grid layout"};
+            }
+            if (viewport.width <= 0 || viewport.height <= 0) {
+                throw std::runtime_error{"Invalid viewport"};
+            }
+
+            // a viewport of height h intersects at most ceil(h / pitch) + 1 rows; indices in the
+            // visible range are contiguous, so index % pool_size never collides
+            const auto rows = static_cast<std::size_t>((viewport.height + row_pitch() - 1) / row_pitch() + 1);
+            slots.assign(rows * static_cast<std::size_t>(get_columns()), Slot{});
+            // the fresh slots are unbound; nothing is visible until update() binds them
+            visible = {};
+            scroll = std::clamp(scroll, 0, get_max_scroll());
+        }
+
+        [[nodiscard]] Range rows_to_items(std::size_t first_row, std::size_t last_row) const noexcept {
+            const auto cols = static_cast<std::size_t>(get_columns());
+            return Range{std::min(first_row * cols, count), std::min(last_row * cols, count)};
+        }
+    public:
+        VirtualGrid(Rect viewport, GridLayout layout,
+            std::function<void(Row&, std::size_t)> bind,
+            std::function<void(std::size_t)> request = {},
+            std::function<void(std::size_t)> evict = {}
+            ) : viewport(viewport), layout(layout), bind(std::move(bind)), request(std::move(request)), evict(std::move(evict)) {
+            if (!this->bind) {
+                throw std::runtime_error{"VirtualGrid needs a bind function"};
+            }
+            relayout();
+        }
+
+        // replaces the catalog: every prefetched item is evicted now, every row is rebound on the next update()
+        void set_item_count(std::size_t n) {
+            if (evict) {
+                for (std::size_t i = prefetched.first; i < prefetched.last; ++i) {
+                    evict(i);
+                }
+            }
+            prefetched = {};
+            visible = {};
+            for (auto& slot : slots) {
+                slot.index = unbound;
+            }
+            count = n;
+            scroll = std::clamp(scroll, 0, get_max_scroll());
+        }
+        void set_viewport(Rect r) {
+            viewport = r;
+            relayout();
+        }
+        void set_layout(GridLayout l) {
+            layout = l;
+            relayout();
+        }
+
+        void scroll_to(int offset) noexcept {
+            scroll = std::clamp(offset, 0, get_max_scroll());
+        }
+        void scroll_by(int delta) noexcept {
+            scroll_to(scroll + delta);
+        }
+        // scrolls the minimum amount needed to bring the item fully into view
+        void scroll_to_item(std::size_t index) noexcept {
+            if (index >= count) {
+                return;
+            }
+            const auto top = static_cast<int>(index / static_cast<std::size_t>(get_columns())) * row_pitch();
+            if (top < scroll) {
+                scroll_to(top);
+            } else if (top + layout.item_height > scroll + viewport.height) {
+                scroll_to(top + layout.item_height - viewport.height);
+            }
+        }
+
+        // recomputes the visible and prefetch ranges, rebinds recycled rows and issues request/evict calls;
+        // call once per frame after scrolling
+        void update() {
+            if (count == 0) {
+                visible = {};
+                return;
+            }
+
+            const auto rows = row_count();
+            // a row whose item is scrolled out and only its spacing is left is not visible
+            const auto first_row = static_cast<std::size_t>(scroll / row_pitch() + (scroll % row_pitch() >= layout.item_height ? 1 : 0));
+            const auto last_row = std::min(rows, static_cast<std::size_t>((scroll + viewport.height - 1) / row_pitch() + 1));
+            visible = rows_to_items(first_row, last_row);
+
+            const auto margin = static_cast<std::size_t>(layout.prefetch_rows);
+            const Range next = rows_to_items(first_row > margin ? first_row - margin : 0, std::min(rows, last_row + margin));
+            if (evict) {
+                for (std::size_t i = prefetched.first; i < prefetched.last; ++i) {
+                    if (!next.contains(i)) {
+                        evict(i);
+                    }
+                }
+            }
+            if (request) {
+                for (std::size_t i = next.first; i < next.last; ++i) {
+                    if (!prefetched.contains(i)) {
+                        request(i);
+                    }
+                }
+            }
+            prefetched = next;
+
+            for (std::size_t i = visible.first; i < visible.last; ++i) {
+                auto& slot = slots[i % slots.size()];
+                if (slot.index != i) {
+                    slot.index = i;
+                    bind(slot.row, i);
+                }
+            }
+        }
+
+        // calls f(row, index, rect) for every visible item, in index order; rect is in screen coordinates
+        // and may extend past the viewport for partially visible rows
+        template <typename F>
+        void for_each_visible(F&& f) {
+            for (std::size_t i = visible.first; i < visible.last; ++i) {
+                f(slots[i % slots.size()].row, i, get_item_rect(i));
+            }
+        }
+
+        [[nodiscard]] Rect get_item_rect(std::size_t index) const noexcept {
+            const auto cols = static_cast<std::size_t>(get_columns());
+            return Rect{
+                .x = viewport.x + static_cast<int>(index % cols) * (layout.item_width + layout.spacing),
+                .y = viewport.y + static_cast<int>(index / cols) * row_pitch() - scroll,
+                .width = layout.item_width,
+                .height = layout.item_height,
+            };
+        }
+
+        // item under a screen position (e.g. the IR pointer), if any
+        [[nodiscard]] std::optional<std::size_t> hit_test(int x, int y) const noexcept {
+            if (x < viewport.x || y < viewport.y || x >= viewport.x + viewport.width || y >= viewport.y + viewport.height) {
+                return std::nullopt;
+            }
+            const auto cx = x - viewport.x;
+            const auto cy = y - viewport.y + scroll;
+            const auto col = cx / (layout.item_width + layout.spacing);
+            if (col >= get_columns() || cx % (layout.item_width + layout.spacing) >= layout.item_width || cy % row_pitch() >= layout.item_height) {
+                return std::nullopt;
+            }
+            const auto index = static_cast<std::size_t>(cy / row_pitch()) * static_cast<std::size_t>(get_columns()) + static_cast<std::size_t>(col);
+            if (index >= count) {
+                return std::nullopt;
+            }
+            return index;
+        }
+
+        [[nodiscard]] int get_columns() const noexcept {
+            if (layout.columns > 0) {
+                return layout.columns;
+            }
+            return std::max(1, (viewport.width + layout.spacing) / (layout.item_width + layout.spacing));
+        }
+        [[nodiscard]] int get_content_height() const noexcept {
+            const auto rows = static_cast<int>(row_count());
+            return rows ? rows * row_pitch() - layout.spacing : 0;
+        }
+        [[nodiscard]] int get_max_scroll() const noexcept {
+            return std::max(0, get_content_height() - viewport.height);
+        }
+        [[nodiscard]] int get_scroll() const noexcept {
+            return scroll;
+        }
+        [[nodiscard]] std::size_t get_item_count() const noexcept {
+            return count;
+        }
+        [[nodiscard]] Range get_visible() const noexcept {
+            return visible;
+        }
+        [[nodiscard]] Range get_prefetched() const noexcept {
+            return prefetched;
+        }
+        // number of pooled row objects, constant for a given viewport and layout
+        [[nodiscard]] std::size_t get_pool_size() const noexcept {
+            return slots.size();
+        }
+    };
+}
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Streaming hashes for verifying downloads while they arrive (see ff::net::Request::body_sink),
+// so packages never have to be read back from the SD card.
+//
+// Broadway is big-endian, so SHA message words are plain loads there and only the CRC needs swapped loads,
+// which GCC turns into a single lwbrx. Rotates compile to rlwinm and the 32 GPRs hold the whole SHA state.
+// Every round loop has a fixed round function and constant and no branch in its body, so the compiler
+// is free to unroll it; the same code is the portable fallback on little-endian hosts.
+// tests/hash_bench.cpp measures throughput.
+namespace ff::hash {
+    namespace detail {
+        inline std::uint32_t load_be32(const std::uint8_t* p) noexcept {
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            if constexpr (std::endian::native == std::endian::little) {
+                v = __builtin_bswap32(v);
+            }
+            return v;
+        }
+        inline std::uint32_t load_le32(const std::uint8_t* p) noexcept {
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            if constexpr (std::endian::native == std::endian::big) {
+                v = __builtin_bswap32(v);
+            }
+            return v;
+        }
+        inline void store_be32(std::uint8_t* p, std::uint32_t v) noexcept {
+            if constexpr (std::endian::native == std::endian::little) {
+                v = __builtin_bswap32(v);
+            }
+            std::memcpy(p, &v, sizeof(v));
+        }
+
+        // Merkle-Damgard padding and buffering shared by SHA-1 and SHA-256 (64 byte blocks, big-endian bit length)
+        template <typename Derived, std::size_t N>
+        class BlockHasher {
+            std::array<std::uint8_t, 64> block{};
+            std::size_t used{};
+            std::uint64_t length{};
+        public:
+            using Digest = std::array<std::uint8_t, N>;
+
+            void update(const void* data, std::size_t size) noexcept {
+                auto* p = static_cast<const std::uint8_t*>(data);
+                length += size;
+
+                if (used) {
+                    const auto n = std::min(size, block.size() - used);
+                    std::memcpy(block.data() + used, p, n);
+                    used += n;
+                    p += n;
+                    size -= n;
+                    if (used < block.size()) {
+                        return;
+                    }
+                    static_cast<Derived*>(this)->compress(block.data());
+                    used = 0;
+                }
+                // hash straight from the caller's buffer where possible
+                for (; size >= block.size(); p += block.size(), size -= block.size()) {
+                    static_cast<Derived*>(this)->compress(p);
+                }
+                std::memcpy(block.data(), p, size);
+                used = size;
+            }
+
+            // returns the digest and resets the hasher
+            Digest finish() noexcept {
+                const auto bits = length * 8;
+                block[used++] = 0x80;
+                if (used > 56) {
+                    std::memset(block.data() + used, 0, block.size() - used);
+                    static_cast<Derived*>(this)->compress(block.data());
+                    used = 0;
+                }
+                std::memset(block.data() + used, 0, 56 - used);
+                store_be32(block.data() + 56, static_cast<std::uint32_t>(bits >> 32));
+                store_be32(block.data() + 60, static_cast<std::uint32_t>(bits));
+                static_cast<Derived*>(this)->compress(block.data());
+
+                Digest digest{};
+                const auto& state = static_cast<Derived*>(this)->state;
+                for (std::size_t i = 0; i < N / 4; ++i) {
+                    store_be32(digest.data() + i * 4, state[i]);
+                }
+
+                static_cast<Derived*>(this)->reset_state();
+                used = 0;
+                length = 0;
+                return digest;
+            }
+        };
+    }
+
+    class Sha1 : public detail::BlockHasher<Sha1, 20> {
+        friend class detail::BlockHasher<Sha1, 20>;
+
+        std::array<std::uint32_t, 5> state{};
+
+        void reset_state() noexcept {
+            state = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        }
+
+        void compress(const std::uint8_t* p) noexcept {
+            std::array<std::uint32_t, 16> w{};
+            for (int i = 0; i < 16; ++i) {
+                w[i] = detail::load_be32(p + i * 4);
+            }
+
+            auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+            const auto round = [&](std::uint32_t f, std::uint32_t k, std::uint32_t wi) {
+                const auto t = std::rotl(a, 5) + f + e + k + wi;
+                e = d;
+                d = c;
+                c = std::rotl(b, 30);
+                b = a;
+                a = t;
+            };
+            // the 80 word schedule is kept as a rolling 16 word window to stay in registers
+            const auto schedule = [&w](int i) {
+                return w[i & 15] = std::rotl(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+            };
+
+            // one loop per group of rounds, so f and k are fixed inside each
+            for (int i = 0; i < 16; ++i) {
+                round((b & c) | (~b & d), 0x5A827999, w[i]);
+            }
+            for (int i = 16; i < 20; ++i) {
+                round((b & c) | (~b & d), 0x5A827999, schedule(i));
+            }
+            for (int i = 20; i < 40; ++i) {
+                round(b ^ c ^ d, 0x6ED9EBA1, schedule(i));
+            }
+            for (int i = 40; i < 60; ++i) {
+                round((b & c) | (b & d) | (c & d), 0x8F1BBCDC, schedule(i));
+            }
+            for (int i = 60; i < 80; ++i) {
+                round(b ^ c ^ d, 0xCA62C1D6, schedule(i));
+            }
+
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+        }
+    public:
+        Sha1() noexcept {
+            reset_state();
+        }
+    };
+
+    class Sha256 : public detail::BlockHasher<Sha256, 32> {
+        friend class detail::BlockHasher<Sha256, 32>;
+
+        static constexpr std::array<std::uint32_t, 64> k{
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        std::array<std::uint32_t, 8> state{};
+
+        void reset_state() noexcept {
+            state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        }
+
+        void compress(const std::uint8_t* p) noexcept {
+            std::array<std::uint32_t, 16> w{};
+            for (int i = 0; i < 16; ++i) {
+                w[i] = detail::load_be32(p + i * 4);
+            }
+
+            auto a = state[0], b = state[1], c = state[2], d = state[3];
+            auto e = state[4], f = state[5], g = state[6], h = state[7];
+            const auto round = [&](int i) {
+                const auto t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i & 15];
+                const auto t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            };
+
+            for (int i = 0; i < 16; ++i) {
+                round(i);
+            }
+            for (int i = 16; i < 64; ++i) {
+                const auto w15 = w[(i + 1) & 15];
+                const auto w2 = w[(i + 14) & 15];
+                const auto s0 = std::rotr(w15, 7) ^ std::rotr(w15, 18) ^ (w15 >> 3);
+                const auto s1 = std::rotr(w2, 17) ^ std::rotr(w2, 19) ^ (w2 >> 10);
+                w[i & 15] += s0 + w[(i + 9) & 15] + s1;
+                round(i);
+            }
+
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+    public:
+        Sha256() noexcept {
+            reset_state();
+        }
+    };
+
+    // CRC-32 as used by zip and PNG (reflected 0xEDB88320), slicing-by-4: four bytes per step
+    // with 4 KiB of tables, which fits comfortably in Broadway's 32 KiB L1 data cache
+    class Crc32 {
+        static constexpr auto tables = []() {
+            std::array<std::array<std::uint32_t, 256>, 4> t{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                auto c = i;
+                for (int j = 0; j < 8; ++j) {
+                    c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+                }
+                t[0][i] = c;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (std::size_t s = 1; s < 4; ++s) {
+                    t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+                }
+            }
+            return t;
+        }();
+
+        std::uint32_t crc{0xFFFFFFFF};
+    public:
+        using Digest = std::array<std::uint8_t, 4>;
+
+        void update(const void* data, std::size_t size) noexcept {
+            auto* p = static_cast<const std::uint8_t*>(data);
+            auto c = crc;
+            for (; size >= 4; p += 4, size -= 4) {
+                c ^= detail::load_le32(p);
+                c = tables[3][c & 0xFF] ^ tables[2][(c >> 8) & 0xFF] ^ tables[1][(c >> 16) & 0xFF] ^ tables[0][c >> 24];
+            }
+            for (; size; ++p, --size) {
+                c = (c >> 8) ^ tables[0][(c ^ *p) & 0xFF];
+            }
+            crc = c;
+        }
+
+        // returns the checksum (big-endian, as it is usually written in hex) and resets the hasher
+        Digest finish() noexcept {
+            Digest digest{};
+            detail::store_be32(digest.data(), crc ^ 0xFFFFFFFF);
+            crc = 0xFFFFFFFF;
+            return digest;
+        }
+    };
+
+    template <std::size_t N>
+    std::string to_hex(const std::array<std::uint8_t, N>& digest) {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string ret(N * 2, '0');
+        for (std::size_t i = 0; i < N; ++i) {
+            ret[i * 2] = digits[digest[i] >> 4];
+            ret[i * 2 + 1] = digits[digest[i] & 0xF];
+        }
+        return ret;
+    }
+
+    enum class Algorithm {
+        CRC32 = 0,
+        SHA1 = 1,
+        SHA256 = 2,
+    };
+
+    // Checks a download against the hash listed in the catalog while it is being received.
+    // Feed it every body chunk with update(), then call verify() before installing.
+    class Verifier {
+        Algorithm algorithm{Algorithm::SHA256};
+        std::string expected{};
+        std::string actual{};
+        Crc32 crc32{};
+        Sha1 sha1{};
+        Sha256 sha256{};
+    public:
+        Verifier(Algorithm algorithm, std::string_view expected_hex) : algorithm(algorithm) {
+            const std::size_t length = algorithm == Algorithm::CRC32 ? 8 : algorithm == Algorithm::SHA1 ? 40 : 64;
+            if (expected_hex.size() != length) {
+                throw std::runtime_error{"expected hash has the wrong length"};
+            }
+            for (const auto ch : expected_hex) {
+                if (ch >= 'A' && ch <= 'F') {
+                    expected += static_cast<char>(ch - 'A' + 'a');
+                } else if ((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f')) {
+                    expected += ch;
+                } else {
+                    throw std::runtime_error{"expected hash is not hex"};
+                }
+            }
+        }
+
+        // picks the algorithm from the length of the hash (8: CRC32, 40: SHA-1, 64: SHA-256)
+        static Verifier from_hex(std::string_view expected_hex) {
+            switch (expected_hex.size()) {
+                case 8: return {Algorithm::CRC32, expected_hex};
+                case 40: return {Algorithm::SHA1, expected_hex};
+                case 64: return {Algorithm::SHA256, expected_hex};
+                default: throw std::runtime_error{"unknown hash length"};
+            }
+        }
+
+        void update(const void* data, std::size_t size) {
+            if (!actual.empty()) {
+                throw std::runtime_error{"Verifier already finished"};
+            }
+            switch (algorithm) {
+                case Algorithm::CRC32: crc32.update(data, size); break;
+                case Algorithm::SHA1: sha1.update(data, size); break;
+                case Algorithm::SHA256: sha256.update(data, size); break;
+            }
+        }
+
+        // digest of everything passed to update(), as lowercase hex; no more data may follow
+        const std::string& finish() {
+            if (actual.empty()) {
+                switch (algorithm) {
+                    case Algorithm::CRC32: actual = to_hex(crc32.finish()); break;
+                    case Algorithm::SHA1: actual = to_hex(sha1.finish()); break;
+                    case Algorithm::SHA256: actual = to_hex(sha256.finish()); break;
+                }
+            }
+            return actual;
+        }
+        [[nodiscard]] bool matches() {
+            return finish() == expected;
+        }
+        void verify() {
+            if (!matches()) {
+                throw std::runtime_error{"hash mismatch: expected " + expected + ", got " + actual};
+            }
+        }
+    };
+}
@@ -3,6 +3,7 @@
 #include <grrlib.h>
 #include <array>
 #include <stdexcept>
+#include <mem.hpp>
 
 namespace ff::img {
     enum class ImageFormat : int {
@@ -20,6 +21,11 @@ namespace ff::img {
         int angle{};
     };
 
+    // GRRLIB keeps every texture as RGBA8 in MEM1/MEM2
+    inline std::size_t texture_bytes(const GRRLIB_texImg* img) noexcept {
+        return img ? static_cast<std::size_t>(img->w) * img->h * 4 : 0;
+    }
+
     template <typename T, std::size_t U>
     class ImageHandler {
         GRRLIB_texImg* img{};
@@ -41,6 +47,7 @@ namespace ff::img {
             if (!img) {
                 throw std::runtime_error("Failed to load image");
             }
+            ff::mem::on_alloc(ff::mem::Tag::Texture, texture_bytes(img));
         }
         void draw(const ImageParameters& params = {}) const {
             if (!img) {
@@ -50,6 +57,7 @@ namespace ff::img {
         }
         ~ImageHandler() noexcept {
             if (img) {
+                ff::mem::on_free(ff::mem::Tag::Texture, texture_bytes(img));
                 GRRLIB_FreeTexture(img);
             }
         }
@@ -61,6 +69,7 @@ namespace ff::img {
             if (!img) {
                 throw std::runtime_error("Failed to load image");
             }
+            ff::mem::on_alloc(ff::mem::Tag::Texture, texture_bytes(img));
         }
         void draw(const ImageParameters& params) const {
             if (!img) {
@@ -70,6 +79,7 @@ namespace ff::img {
         }
         ~TexImageHandler() noexcept {
             if (img) {
+                ff::mem::on_free(ff::mem::Tag::Texture, texture_bytes(img));
                 GRRLIB_FreeTexture(img);
             }
         }
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <wiiuse/wpad.h>
+
+namespace ff::input {
+    static constexpr int channel_count = 4;
+
+    // Single-producer single-consumer ring buffer. One thread may push() and one other thread may pop();
+    // neither side ever blocks. N must be a power of two.
+    template <typename T, std::size_t N>
+    class SpscQueue {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+        std::array<T, N> buffer{};
+        // kept on separate 32 byte (Broadway cache line) lines so the two threads do not contend
+        alignas(32) std::atomic<std::size_t> head{}; // next slot to read, owned by the consumer
+        alignas(32) std::atomic<std::size_t> tail{}; // next slot to write, owned by the producer
+    public:
+        // returns false if the queue is full
+        bool push(const T& value) noexcept {
+            const auto t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N) {
+                return false;
+            }
+            buffer[t & (N - 1)] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+        // returns false if the queue is empty
+        bool pop(T& value) noexcept {
+            const auto h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = buffer[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+        [[nodiscard]] bool empty() const noexcept {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+        [[nodiscard]] static constexpr std::size_t capacity() noexcept {
+            return N;
+        }
+    };
+
+    enum class EventType {
+        Press = 0,
+        Release = 1,
+    };
+
+    // calls f once for every set bit in mask, lowest first
+    template <typename F>
+    void for_each_bit(std::uint32_t mask, F&& f) {
+        while (mask) {
+            const auto bit = mask & (~mask + 1);
+            mask &= ~bit;
+            f(bit);
+        }
+    }
+
+    struct Event {
+        int channel{};
+        EventType type{EventType::Press};
+        std::uint32_t button{}; // a single WPAD_BUTTON_* bit
+        std::chrono::steady_clock::time_point timestamp{};
+    };
+
+    struct IRSample {
+        double x{320};
+        double y{240};
+        double angle{0};
+        bool valid{false};
+    };
+
+    // Samples every Wiimote on its own thread, much faster than the frame rate, so presses
+    // between two frames are not lost. Button transitions go into a lock-free queue that the
+    // main loop drains with drain(); IR is kept as the latest sample per channel.
+    // WPAD must already be initialized, and nothing else may call WPAD_ScanPads() while this runs.
+    // Held buttons are published as a snapshot per channel rather than derived from the events,
+    // so buttons already down at startup or a release lost to a full queue cannot get stuck.
+    class Sampler {
+        static constexpr std::size_t queue_size = 256;
+
+        // the running sampler, so stop_active() can reach it from anywhere before WPAD goes away
+        static inline std::atomic<Sampler*> active{nullptr};
+
+        SpscQueue<Event, queue_size> events{};
+        std::array<std::atomic<std::uint32_t>, channel_count> held{};
+        std::array<IRSample, channel_count> ir{};
+        mutable std::mutex ir_mutex{};
+        std::atomic<bool> running{true};
+        std::atomic<std::size_t> dropped{};
+        std::chrono::microseconds period{};
+        bool sample_ir{};
+        std::thread thread{};
+
+        void push_transitions(int channel, std::uint32_t mask, EventType type, std::chrono::steady_clock::time_point now) noexcept {
+            for_each_bit(mask, [&](std::uint32_t bit) {
+                if (!events.push(Event{.channel = channel, .type = type, .button = bit, .timestamp = now})) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        void run() noexcept {
+            while (running.load(std::memory_order_relaxed)) {
+                WPAD_ScanPads();
+                const auto now = std::chrono::steady_clock::now();
+
+                std::array<IRSample, channel_count> latest{};
+                for (int ch = 0; ch < channel_count; ++ch) {
+                    push_transitions(ch, WPAD_ButtonsDown(ch), EventType::Press, now);
+                    push_transitions(ch, WPAD_ButtonsUp(ch), EventType::Release, now);
+                    held[ch].store(WPAD_ButtonsHeld(ch), std::memory_order_relaxed);
+
+                    if (sample_ir) {
+                        ir_t r_ir{};
+                        WPAD_IR(ch, &r_ir);
+                        latest[ch] = IRSample{r_ir.x, r_ir.y, r_ir.angle, static_cast<bool>(r_ir.valid)};
+                    }
+                }
+                if (sample_ir) {
+                    std::lock_guard lock{ir_mutex};
+                    ir = latest;
+                }
+
+                std::this_thread::sleep_for(period);
+            }
+        }
+    public:
+        explicit Sampler(bool sample_ir = true, std::chrono::microseconds period = std::chrono::microseconds{4000})
+            : period(period), sample_ir(sample_ir) {
+            thread = std::thread([this]() {
+                this->run();
+            });
+            active.store(this);
+        }
+
+        // stops sampling and waits for the thread; safe to call more than once
+        void stop() {
+            running.store(false, std::memory_order_relaxed);
+            if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+                thread.join();
+            }
+        }
+
+        // stops the running sampler, if any; for shutdown paths that never reach ~Context
+        static void stop_active() {
+            if (auto* sampler = active.load()) {
+                sampler->stop();
+            }
+        }
+
+        // appends every event queued since the last call, oldest first
+        void drain(std::vector<Event>& out) {
+            Event e{};
+            while (events.pop(e)) {
+                out.push_back(e);
+            }
+        }
+
+        // buttons down on the channel as of the latest sample
+        [[nodiscard]] std::uint32_t get_held(int channel) const {
+            return held.at(channel).load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] IRSample get_ir(int channel) const {
+            std::lock_guard lock{ir_mutex};
+            return ir.at(channel);
+        }
+
+        // number of events lost because the main loop did not drain the queue in time
+        [[nodiscard]] std::size_t get_dropped() const noexcept {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        ~Sampler() {
+            auto* self = this;
+            active.compare_exchange_strong(self, nullptr);
+            stop();
+        }
+
+        Sampler(const Sampler&) = delete;
+        Sampler& operator=(const Sampler&) = delete;
+        Sampler(Sampler&&) = delete;
+        Sampler& operator=(Sampler&&) = delete;
+    };
+}
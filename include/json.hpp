@@ -0,0 +1,17 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <mem.hpp>
+
+namespace ff::json {
+    // strings are the bulk of a catalog, so keys and values use the tracked allocator too
+    using String = std::basic_string<char, std::char_traits<char>, ff::mem::JsonAllocator<char>>;
+    using Binary = std::vector<std::uint8_t, ff::mem::JsonAllocator<std::uint8_t>>;
+
+    // nlohmann::json with every node, string and binary allocation accounted to ff::mem::Tag::Json
+    using Json = nlohmann::basic_json<std::map, std::vector, String, bool, std::int64_t, std::uint64_t, double, ff::mem::JsonAllocator, nlohmann::adl_serializer, Binary>;
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#ifdef __DEVKITPPC__
+#include <ogc/system.h>
+#else
+#include <cstdio>
+#ifndef SYS_Report
+#define SYS_Report(...) std::fprintf(stderr, __VA_ARGS__)
+#endif
+#endif
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Memory accounting per subsystem.
+// Define FF_MEM_TRACKING to enable it; otherwise every call below compiles to nothing,
+// and the statistics are always zero.
+namespace ff::mem {
+    // Fonts and audio have no tag: GRRLIB_LoadTTF allocates the FreeType face inside FreeType
+    // and the MP3 player decodes into libogc's static buffers, so neither allocation is visible here,
+    // and the handlers themselves only reference data embedded in the binary.
+    enum class Tag : int {
+        Net = 0,
+        Texture = 1,
+        Json = 2,
+        Other = 3,
+        Count = 4,
+    };
+
+    static constexpr const char* tag_name(Tag tag) noexcept {
+        switch (tag) {
+            case Tag::Net: return "net";
+            case Tag::Texture: return "texture";
+            case Tag::Json: return "json";
+            case Tag::Other: return "other";
+            default: return "unknown";
+        }
+    }
+
+    struct Stats {
+        std::size_t live_bytes{};
+        std::size_t peak_bytes{};
+        std::size_t allocations{};
+        std::size_t frees{};
+
+        [[nodiscard]] std::size_t live_allocations() const noexcept {
+            return allocations - frees;
+        }
+    };
+
+#ifdef FF_MEM_TRACKING
+    static constexpr bool tracking_enabled = true;
+#else
+    static constexpr bool tracking_enabled = false;
+#endif
+
+    class Tracker {
+        struct Counters {
+            std::atomic<std::size_t> live_bytes{};
+            std::atomic<std::size_t> peak_bytes{};
+            std::atomic<std::size_t> allocations{};
+            std::atomic<std::size_t> frees{};
+        };
+
+        std::array<Counters, static_cast<std::size_t>(Tag::Count)> counters{};
+
+        Counters& get(Tag tag) noexcept {
+            return counters[static_cast<std::size_t>(tag)];
+        }
+
+        Tracker() = default;
+    public:
+        static Tracker& instance() noexcept {
+            static Tracker tracker{};
+            return tracker;
+        }
+
+        void on_alloc(Tag tag, std::size_t bytes) noexcept {
+            if constexpr (tracking_enabled) {
+                auto& c = get(tag);
+                const auto live = c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+                auto peak = c.peak_bytes.load(std::memory_order_relaxed);
+                while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+                c.allocations.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                static_cast<void>(tag);
+                static_cast<void>(bytes);
+            }
+        }
+
+        void on_free(Tag tag, std::size_t bytes) noexcept {
+            if constexpr (tracking_enabled) {
+                auto& c = get(tag);
+                c.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+                c.frees.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                static_cast<void>(tag);
+                static_cast<void>(bytes);
+            }
+        }
+
+        // adjusts live bytes of an existing allocation without counting a new one,
+        // used for buffers that grow in place
+        void on_resize(Tag tag, std::size_t old_bytes, std::size_t new_bytes) noexcept {
+            if constexpr (tracking_enabled) {
+                auto& c = get(tag);
+                if (new_bytes >= old_bytes) {
+                    const auto diff = new_bytes - old_bytes;
+                    const auto live = c.live_bytes.fetch_add(diff, std::memory_order_relaxed) + diff;
+                    auto peak = c.peak_bytes.load(std::memory_order_relaxed);
+                    while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+                } else {
+                    c.live_bytes.fetch_sub(old_bytes - new_bytes, std::memory_order_relaxed);
+                }
+            } else {
+                static_cast<void>(tag);
+                static_cast<void>(old_bytes);
+                static_cast<void>(new_bytes);
+            }
+        }
+
+        [[nodiscard]] Stats get_stats(Tag tag) noexcept {
+            auto& c = get(tag);
+            return Stats{
+                .live_bytes = c.live_bytes.load(std::memory_order_relaxed),
+                .peak_bytes = c.peak_bytes.load(std::memory_order_relaxed),
+                .allocations = c.allocations.load(std::memory_order_relaxed),
+                .frees = c.frees.load(std::memory_order_relaxed),
+            };
+        }
+
+        void report() noexcept {
+            if constexpr (!tracking_enabled) {
+                SYS_Report("mem: tracking disabled (build with FF_MEM_TRACKING)\n");
+                return;
+            }
+            SYS_Report("mem: %-8s %10s %10s %8s %8s\n", "tag", "live", "peak", "allocs", "frees");
+            for (int i = 0; i < static_cast<int>(Tag::Count); ++i) {
+                const auto tag = static_cast<Tag>(i);
+                const auto s = get_stats(tag);
+                SYS_Report("mem: %-8s %10zu %10zu %8zu %8zu\n", tag_name(tag), s.live_bytes, s.peak_bytes, s.allocations, s.frees);
+            }
+        }
+
+        // returns true if anything is still allocated
+        bool report_leaks() noexcept {
+            if constexpr (!tracking_enabled) {
+                return false;
+            }
+            bool leaked = false;
+            for (int i = 0; i < static_cast<int>(Tag::Count); ++i) {
+                const auto tag = static_cast<Tag>(i);
+                const auto s = get_stats(tag);
+                if (s.live_bytes != 0 || s.live_allocations() != 0) {
+                    SYS_Report("mem: leak in %s: %zu bytes in %zu allocations\n", tag_name(tag), s.live_bytes, s.live_allocations());
+                    leaked = true;
+                }
+            }
+            return leaked;
+        }
+
+        Tracker(const Tracker&) = delete;
+        Tracker& operator=(const Tracker&) = delete;
+        Tracker(Tracker&&) = delete;
+        Tracker& operator=(Tracker&&) = delete;
+    };
+
+    // the free functions skip the Tracker singleton entirely when tracking is disabled
+    inline void on_alloc(Tag tag, std::size_t bytes) noexcept {
+        if constexpr (tracking_enabled) {
+            Tracker::instance().on_alloc(tag, bytes);
+        }
+    }
+    inline void on_free(Tag tag, std::size_t bytes) noexcept {
+        if constexpr (tracking_enabled) {
+            Tracker::instance().on_free(tag, bytes);
+        }
+    }
+    [[nodiscard]] inline Stats get_stats(Tag tag) noexcept {
+        return Tracker::instance().get_stats(tag);
+    }
+    inline void report() noexcept {
+        Tracker::instance().report();
+    }
+    inline bool report_leaks() noexcept {
+        return Tracker::instance().report_leaks();
+    }
+
+    // Accounts for a single buffer that is owned elsewhere (a texture, a std::string being filled, ...).
+    // The recorded size follows resize() and is released when the reservation is destroyed.
+    // An empty reservation accounts for nothing: an allocation is counted when the size goes from 0
+    // to non-zero and a free when it goes back to 0. Copies account for a second buffer of the same size;
+    // moves hand the accounting over and leave the source empty.
+    class Reservation {
+        Tag tag{Tag::Other};
+        std::size_t bytes{};
+    public:
+        explicit Reservation(Tag tag, std::size_t bytes = 0) noexcept : tag(tag) {
+            resize(bytes);
+        }
+        void resize(std::size_t new_bytes) noexcept {
+            if (new_bytes == bytes) {
+                return;
+            }
+            if (bytes == 0) {
+                on_alloc(tag, new_bytes);
+            } else if (new_bytes == 0) {
+                on_free(tag, bytes);
+            } else if constexpr (tracking_enabled) {
+                Tracker::instance().on_resize(tag, bytes, new_bytes);
+            }
+            bytes = new_bytes;
+        }
+        [[nodiscard]] std::size_t size() const noexcept {
+            return bytes;
+        }
+        ~Reservation() noexcept {
+            resize(0);
+        }
+
+        Reservation(const Reservation& other) noexcept : tag(other.tag) {
+            resize(other.bytes);
+        }
+        Reservation& operator=(const Reservation& other) noexcept {
+            if (this != &other) {
+                resize(0);
+                tag = other.tag;
+                resize(other.bytes);
+            }
+            return *this;
+        }
+        Reservation(Reservation&& other) noexcept : tag(other.tag), bytes(other.bytes) {
+            other.bytes = 0;
+        }
+        Reservation& operator=(Reservation&& other) noexcept {
+            if (this != &other) {
+                resize(0);
+                tag = other.tag;
+                bytes = other.bytes;
+                other.bytes = 0;
+            }
+            return *this;
+        }
+    };
+
+    // std-compatible allocator that accounts every allocation to a tag.
+    template <typename T, Tag tag>
+    struct TrackedAllocator {
+        using value_type = T;
+
+        TrackedAllocator() noexcept = default;
+        template <typename U>
+        TrackedAllocator(const TrackedAllocator<U, tag>&) noexcept {} // NOLINT(google-explicit-constructor)
+
+        template <typename U>
+        struct rebind {
+            using other = TrackedAllocator<U, tag>;
+        };
+
+        [[nodiscard]] T* allocate(std::size_t n) {
+            auto* p = static_cast<T*>(::operator new(n * sizeof(T)));
+            on_alloc(tag, n * sizeof(T));
+            return p;
+        }
+        void deallocate(T* p, std::size_t n) noexcept {
+            on_free(tag, n * sizeof(T));
+            ::operator delete(p);
+        }
+
+        template <typename U>
+        bool operator==(const TrackedAllocator<U, tag>&) const noexcept {
+            return true;
+        }
+    };
+
+    template <typename T>
+    using JsonAllocator = TrackedAllocator<T, Tag::Json>;
+}
@@ -16,12 +16,18 @@
 #define net_gethostbyname gethostbyname
 #define net_gethostip gethostip
 #define net_init() 0
+#define net_deinit()
 #define net_select select
 
 #include <sys/socket.h>
 #endif
 #include <string>
 #include <stdexcept>
+#include <mutex>
+#include <functional>
+#include <optional>
+#include <mem.hpp>
+#include <hash.hpp>
 
 namespace ff::net {
     enum class Version {
@@ -33,6 +39,9 @@ namespace ff::net {
         POST,
     };
 
+    // receives the response body piece by piece as it comes off the socket
+    using BodySink = std::function<void(const char* data, std::size_t size)>;
+
     struct Request {
         std::string hostname{};
         std::string path{"/"};
@@ -42,6 +51,9 @@ namespace ff::net {
         Version version{Version::HTTP_1_1};
         std::string body{};
         std::vector<std::pair<std::string, std::string>> headers{};
+        BodySink body_sink{}; // if set, the body is streamed here instead of being stored in Response::body;
+                              // any status but 200 then throws before the sink sees a byte,
+                              // and a connection error or a cut-off body throws once the transfer ends
     };
 
     struct Response {
@@ -49,6 +61,7 @@ namespace ff::net {
         std::string body{};
         std::string raw_body{};
         std::vector<std::pair<std::string, std::string>> headers{};
+        ff::mem::Reservation body_mem{ff::mem::Tag::Net}; // accounts for body as returned by Client::get()
     };
 
     static std::string decode_chunked(const std::string& encoded) {
@@ -79,17 +92,153 @@ namespace ff::net {
         return decoded;
     }
 
+    // Incremental counterpart of decode_chunked() for streamed bodies; the input may be split anywhere.
+    class ChunkedDecoder {
+        enum class State {
+            Size,
+            Extension,
+            Data,
+            DataEnd,
+            Done,
+        };
+
+        State state{State::Size};
+        std::size_t remaining{};
+    public:
+        void feed(const char* data, std::size_t size, const BodySink& sink) {
+            while (size && state != State::Done) {
+                if (state == State::Data) {
+                    const auto n = std::min(size, remaining);
+                    sink(data, n);
+                    data += n;
+                    size -= n;
+                    remaining -= n;
+                    if (!remaining) {
+                        state = State::DataEnd;
+                    }
+                    continue;
+                }
+
+                const auto ch = *data++;
+                --size;
+                if (ch == '\n') {
+                    if (state == State::DataEnd) {
+                        state = State::Size;
+                    } else {
+                        state = remaining ? State::Data : State::Done;
+                    }
+                    continue;
+                }
+                if (state != State::Size || ch == '\r') {
+                    continue;
+                }
+
+                int digit = -1;
+                if (ch >= '0' && ch <= '9') digit = ch - '0';
+                else if (ch >= 'a' && ch <= 'f') digit = ch - 'a' + 10;
+                else if (ch >= 'A' && ch <= 'F') digit = ch - 'A' + 10;
+
+                if (digit < 0) {
+                    state = State::Extension; // ";name=value" after the size, ignored
+                } else if (remaining > (static_cast<std::size_t>(-1) >> 4)) {
+                    throw std::runtime_error{"chunk size too large"};
+                } else {
+                    remaining = remaining * 16 + static_cast<std::size_t>(digit);
+                }
+            }
+        }
+        [[nodiscard]] bool is_done() const noexcept {
+            return state == State::Done;
+        }
+    };
+
+    // Brings up the network stack once per process. net_init() can block for seconds,
+    // so ff::sys::Context calls this on a worker thread when ContextParams::Network is set;
+    // any other caller blocks until that finishes. If it throws, the next call retries.
+    inline void init() {
+        static std::once_flag flag{};
+        std::call_once(flag, []() {
+            if (net_init() < 0) {
+                throw std::runtime_error{"failed to init networking"};
+            }
+        });
+    }
+
     class Client {
-        public:
-            explicit Client() {
-                if (net_init() < 0) {
-                    throw std::runtime_error{"failed to init networking"};
+            struct SocketGuard {
+                int sock{-1};
+
+                ~SocketGuard() {
+                    if (sock >= 0) {
+                        net_close(sock);
+                    }
+                }
+            };
+
+            static void parse_headers(const std::string& headers_str, Response& ret) {
+                std::istringstream headers_stream(headers_str);
+                std::string status_line;
+                if (std::getline(headers_stream, status_line)) {
+                    if (status_line.back() == '\r') status_line.pop_back();
+                    auto code_pos = status_line.find(' ');
+                    if (code_pos != std::string::npos) {
+                        auto code_end = status_line.find(' ', code_pos + 1);
+                        if (code_end != std::string::npos) {
+                            try {
+                                ret.status_code = std::stoi(status_line.substr(code_pos + 1, code_end - code_pos - 1));
+                            } catch (...) {
+                                ret.status_code = -1;
+                            }
+                        }
+                    }
+                }
+
+                std::string line;
+                while (std::getline(headers_stream, line)) {
+                    if (line.back() == '\r') line.pop_back();
+                    auto colon_pos = line.find(':');
+                    if (colon_pos != std::string::npos) {
+                        auto key = line.substr(0, colon_pos);
+                        auto value = line.substr(colon_pos + 1);
+                        auto trim = [](std::string& s) {
+                            s.erase(0, s.find_first_not_of(" \t"));
+                            s.erase(s.find_last_not_of(" \t") + 1);
+                        };
+                        trim(key);
+                        trim(value);
+                        ret.headers.emplace_back(key, value);
+                    }
                 }
             }
-            ~Client() {
-                net_deinit();
+
+            static bool is_chunked(const Response& response) {
+                for (const auto& [key, value] : response.headers) {
+                    if (key == "Transfer-Encoding" && value.find("chunked") != std::string::npos) {
+                        return true;
+                    }
+                }
+                return false;
             }
 
+            // declared body size, if the server sent a valid Content-Length
+            static std::optional<std::size_t> content_length(const Response& response) {
+                for (const auto& [key, value] : response.headers) {
+                    if (key == "Content-Length") {
+                        try {
+                            return static_cast<std::size_t>(std::stoull(value));
+                        } catch (...) {
+                            return std::nullopt;
+                        }
+                    }
+                }
+                return std::nullopt;
+            }
+        public:
+            explicit Client() {
+                init();
+            }
+            ~Client() = default;
+
             static std::string get_wii_ip() {
                 char my_ip[16];
                 unsigned int ip = net_gethostip();
@@ -103,9 +252,10 @@ namespace ff::net {
                 if (sock < 0) {
                     throw std::runtime_error{"failed to create socket"};
                 }
+                // closes the socket on every path out, including exceptions thrown by the body sink
+                const SocketGuard guard{sock};
 
                 if (request.path.empty() || request.path[0] != '/') {
-                    net_close(sock);
                     throw std::runtime_error{"path must start with /"};
                 }
 
@@ -120,14 +270,12 @@ namespace ff::net {
                     throw std::runtime_error("DNS resolution failed");
                 }
                 if (host->h_addrtype != AF_INET) {
-                    net_close(sock);
                     throw std::runtime_error{"unsupported address type"};
                 }
 
                 memcpy(&server.sin_addr, host->h_addr_list[0], sizeof(server.sin_addr));
 
                 if (net_connect(sock, reinterpret_cast<sockaddr*>(&server), sizeof(server)) < 0) {
-                    net_close(sock);
                     throw std::runtime_error{"failed to connect to server"};
                 }
 
@@ -162,72 +310,112 @@ namespace ff::net {
                 }
 
                 if (net_send(sock, body.c_str(), static_cast<int32_t>(body.size()), 0) < 0) {
-                    net_close(sock);
                     throw std::runtime_error{"failed to send request"};
                 }
 
                 std::string response{};
+                ff::mem::Reservation response_mem{ff::mem::Tag::Net};
                 char buffer[1024];
                 int bytes_received = 0;
 
-                while ((bytes_received = net_recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-                    buffer[bytes_received] = '\0'; // null-terminate the string
-                    response += buffer;
+                Response ret{};
+                // with a body sink only the headers are buffered; once they are parsed
+                // every received byte goes straight to the sink
+                bool streaming = false;
+                bool chunked = false;
+                ChunkedDecoder decoder{};
+                std::size_t streamed = 0;
+                const auto emit = [&](const char* data, std::size_t size) {
+                    if (chunked) {
+                        decoder.feed(data, size, request.body_sink);
+                    } else if (size) {
+                        request.body_sink(data, size);
+                        streamed += size;
+                    }
+                };
+
+                while ((bytes_received = net_recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+                    if (streaming) {
+                        emit(buffer, static_cast<std::size_t>(bytes_received));
+                        continue;
+                    }
+
+                    response.append(buffer, static_cast<std::size_t>(bytes_received));
+                    response_mem.resize(response.capacity());
+
+                    if (request.body_sink) {
+                        const auto end = response.find("\r\n\r\n");
+                        if (end != std::string::npos) {
+                            parse_headers(response.substr(0, end), ret);
+                            // never let an error page reach the sink (e.g. the package file on SD)
+                            if (ret.status_code != 200) {
+                                throw std::runtime_error{"unexpected status code: " + std::to_string(ret.status_code)};
+                            }
+                            chunked = is_chunked(ret);
+                            streaming = true;
+                            emit(response.data() + end + 4, response.size() - end - 4);
+                            response.clear();
+                            response.shrink_to_fit();
+                            response_mem.resize(0);
+                        }
+                    }
                 }
 
-                Response ret{};
+                // with a sink the body is gone by now, so a cut-off transfer must not look like a complete one
+                if (request.body_sink) {
+                    if (bytes_received < 0) {
+                        throw std::runtime_error{"connection error while receiving the body: " + std::to_string(bytes_received)};
+                    }
+                    if (!streaming) {
+                        throw std::runtime_error{"connection closed before the end of the headers"};
+                    }
+                    if (chunked && !decoder.is_done()) {
+                        throw std::runtime_error{"connection closed before the last chunk"};
+                    }
+                    if (const auto length = content_length(ret); !chunked && length && streamed != *length) {
+                        throw std::runtime_error{"connection closed after " + std::to_string(streamed) + " of " + std::to_string(*length) + " bytes"};
+                    }
+                    return ret;
+                }
 
                 const auto pos = response.find("\r\n\r\n");
                 if (pos == std::string::npos) {
                     SYS_Report("no header terminator\n");
-                    ret.body = response;
+                    ret.body = std::move(response);
+                    ret.body_mem = std::move(response_mem);
+                    ret.body_mem.resize(ret.body.capacity());
                     return ret;
                 }
 
                 std::string headers_str = response.substr(0, pos);
-                ret.body = response.substr(pos + 4); // skip the \r\n\r\n
+                response.erase(0, pos + 4); // skip the \r\n\r\n
+                ret.body = std::move(response);
+                ret.body_mem = std::move(response_mem);
 
-                std::istringstream headers_stream(headers_str);
-                std::string status_line;
-                if (std::getline(headers_stream, status_line)) {
-                    if (status_line.back() == '\r') status_line.pop_back();
-                    auto code_pos = status_line.find(' ');
-                    if (code_pos != std::string::npos) {
-                        auto code_end = status_line.find(' ', code_pos + 1);
-                        if (code_end != std::string::npos) {
-                            try {
-                                ret.status_code = std::stoi(status_line.substr(code_pos + 1, code_end - code_pos - 1));
-                            } catch (...) {
-                                ret.status_code = -1;
-                            }
-                        }
-                    }
-                }
+                parse_headers(headers_str, ret);
 
-                std::string line;
-                while (std::getline(headers_stream, line)) {
-                    if (line.back() == '\r') line.pop_back();
-                    auto colon_pos = line.find(':');
-                    if (colon_pos != std::string::npos) {
-                        auto key = line.substr(0, colon_pos);
-                        auto value = line.substr(colon_pos + 1);
-                        auto trim = [](std::string& s) {
-                            s.erase(0, s.find_first_not_of(" \t"));
-                            s.erase(s.find_last_not_of(" \t") + 1);
-                        };
-                        trim(key);
-                        trim(value);
-                        ret.headers.emplace_back(key, value);
-                    }
+                if (is_chunked(ret)) {
+                    ret.body = decode_chunked(ret.body);
                 }
+                ret.body_mem.resize(ret.body.capacity());
 
-                for (const auto& [key, value] : ret.headers) {
-                    if (key == "Transfer-Encoding" && value.find("chunked") != std::string::npos) {
-                        ret.body = decode_chunked(ret.body);
-                        break;
+                return ret;
+            }
+
+            // Streams the body of a GET into sink while hashing it, then throws if the digest does not
+            // match what verifier expects, so a package can be rejected without reading it back.
+            static Response download(Request request, ff::hash::Verifier& verifier, const BodySink& sink = {}) {
+                request.body_sink = [&verifier, &sink](const char* data, std::size_t size) {
+                    verifier.update(data, size);
+                    if (sink) {
+                        sink(data, size);
                     }
-                }
+                };
 
+                // get() throws on a non-200 status before anything reaches the sink and on a truncated
+                // transfer, so only a body that arrived completely gets to the digest check
+                auto ret = get(request);
+                verifier.verify();
                 return ret;
             }
     };
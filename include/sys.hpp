@@ -2,12 +2,23 @@
 
 #include <thread>
 #include <mutex>
+#include <future>
+#include <chrono>
+#include <array>
+#include <string>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <grrlib.h>
 #include <ogc/system.h>
 #include <gccore.h>
 #include <wiiuse/wpad.h>
 #include <fat.h>
 #include <asndlib.h>
+#include <mem.hpp>
+#include <audio.hpp>
+#include <net.hpp>
+#include <input.hpp>
 
 namespace ff::sys {
     enum class ContextParams {
@@ -19,6 +30,10 @@ namespace ff::sys {
         GenericInput = 1 << 5,
         IR = GenericInput | 1 << 6,
         ControllerInput = IR,
+        MemoryReport = 1 << 7, // print ff::mem statistics and leaks when the Context is destroyed
+        Network = 1 << 8, // bring up networking in the background
+        BootTiming = 1 << 9, // print how long each subsystem took to become ready
+        InputThread = 1 << 10, // with GenericInput, sample all Wiimotes on a dedicated thread instead of once per poll()
         Default = Graphics | ControllerInput | Filesystem | Audio,
     };
 
@@ -32,6 +47,29 @@ namespace ff::sys {
         return static_cast<T>(lhs) & static_cast<T>(rhs);
     }
 
+    // Subsystems the Context brings up. Everything except Network is initialized in sequence on the calling thread.
+    enum class Subsystem : int {
+        Filesystem = 0,
+        Audio = 1,
+        Graphics = 2,
+        Input = 3,
+        Network = 4,
+        System = 5, // WII_Initialize()
+        Count = 6,
+    };
+
+    static constexpr const char* subsystem_name(Subsystem subsystem) noexcept {
+        switch (subsystem) {
+            case Subsystem::Filesystem: return "filesystem";
+            case Subsystem::Audio: return "audio";
+            case Subsystem::Graphics: return "graphics";
+            case Subsystem::Input: return "input";
+            case Subsystem::Network: return "network";
+            case Subsystem::System: return "system";
+            default: return "unknown";
+        }
+    }
+
     enum class CallbackType {
         OnFrame = 0,
         OnError = 1,
@@ -99,8 +137,14 @@ namespace ff::sys {
         IR() = default;
 
         void assign_values(double x, double y, double angle, bool validity) {
-            pointer_x = x;
-            pointer_y = y;
+            // only smooth between two valid samples, otherwise the pointer would drift in from the old position
+            if (smoothing > 0 && validity && pointer_validity) {
+                pointer_x += (x - pointer_x) * (1 - smoothing);
+                pointer_y += (y - pointer_y) * (1 - smoothing);
+            } else {
+                pointer_x = x;
+                pointer_y = y;
+            }
             pointer_a = angle;
             pointer_validity = validity;
         }
@@ -109,9 +153,19 @@ namespace ff::sys {
         double pointer_y{240};
         double pointer_a{0};
         bool pointer_validity{false};
+        double smoothing{0};
     public:
         friend class Context;
 
+        // exponential smoothing of the pointer position; 0 disables it,
+        // values closer to 1 give a steadier pointer at the cost of latency
+        void set_smoothing(double s) {
+            if (s < 0 || s >= 1) {
+                throw std::runtime_error{"IR smoothing must be in [0, 1)"};
+            }
+            smoothing = s;
+        }
+
         [[nodiscard]] double get_x() const noexcept {
             return pointer_x;
         }
@@ -129,31 +183,50 @@ namespace ff::sys {
     // Buttons class is used to get the state of the controller buttons
     // It should NOT be static, because we only want the functions to work
     // if ContextParams::GenericInput is set
+    // The state is updated by Context::poll() and stays the same for the rest of the frame.
+    // get_* return a bitmask of every button involved; use is_* to test for one button
+    // so that chords (e.g. A + B) are not missed.
     struct Buttons final {
-        [[nodiscard]] ControllerButton get_pressed() {
-            static_cast<void*>(this);
-            return static_cast<ControllerButton>(WPAD_ButtonsDown(0));
+        [[nodiscard]] ControllerButton get_pressed(int channel = 0) const {
+            return static_cast<ControllerButton>(pressed.at(channel));
+        }
+        [[nodiscard]] ControllerButton get_held(int channel = 0) const {
+            return static_cast<ControllerButton>(held.at(channel));
+        }
+        [[nodiscard]] ControllerButton get_up(int channel = 0) const {
+            return static_cast<ControllerButton>(up.at(channel));
         }
-        [[nodiscard]] ControllerButton get_held() {
-            static_cast<void*>(this);
-            return static_cast<ControllerButton>(WPAD_ButtonsHeld(0));
+        [[nodiscard]] bool is_pressed(ControllerButton button, int channel = 0) const {
+            return pressed.at(channel) & static_cast<std::uint32_t>(button);
         }
-        [[nodiscard]] ControllerButton get_up() {
-            static_cast<void*>(this);
-            return static_cast<ControllerButton>(WPAD_ButtonsUp(0));
+        [[nodiscard]] bool is_held(ControllerButton button, int channel = 0) const {
+            return held.at(channel) & static_cast<std::uint32_t>(button);
+        }
+        [[nodiscard]] bool is_up(ControllerButton button, int channel = 0) const {
+            return up.at(channel) & static_cast<std::uint32_t>(button);
         }
 
         friend class Context;
     private: // must not be initialized and used aside from by Context
         Buttons() = default;
+
+        std::array<std::uint32_t, ff::input::channel_count> pressed{};
+        std::array<std::uint32_t, ff::input::channel_count> held{};
+        std::array<std::uint32_t, ff::input::channel_count> up{};
     };
 
     class Context {
         ContextParams params{ContextParams::Default};
         Buttons buttons{};
-        IR ir{};
+        std::array<IR, ff::input::channel_count> ir{IR{}, IR{}, IR{}, IR{}};
+        std::unique_ptr<ff::input::Sampler> sampler{};
+        std::vector<ff::input::Event> events{};
         ScreenDimensions screen_dimensions{640, 480};
 
+        std::chrono::steady_clock::time_point boot_start{std::chrono::steady_clock::now()};
+        std::array<std::shared_future<void>, static_cast<std::size_t>(Subsystem::Count)> ready{};
+        bool input_ready{false};
+
         std::function<void()> on_frame{};
         std::function<void(const std::string&)> on_error{};
 
@@ -161,6 +234,37 @@ namespace ff::sys {
             on_error(str);
         }
 
+        void report_ready(Subsystem subsystem, std::chrono::steady_clock::time_point started) const {
+            if (!(params & ContextParams::BootTiming)) {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            const auto took = std::chrono::duration_cast<std::chrono::microseconds>(now - started).count();
+            const auto since_boot = std::chrono::duration_cast<std::chrono::microseconds>(now - boot_start).count();
+            SYS_Report("boot: %s ready in %lld us (%lld us after boot)\n", subsystem_name(subsystem),
+                static_cast<long long>(took), static_cast<long long>(since_boot));
+        }
+
+        // runs f on a worker thread; the subsystem's future becomes ready when f returns
+        void start_async(Subsystem subsystem, std::function<void()> f) {
+            ready[static_cast<std::size_t>(subsystem)] = std::async(std::launch::async, [this, subsystem, f = std::move(f)]() {
+                const auto started = std::chrono::steady_clock::now();
+                f();
+                this->report_ready(subsystem, started);
+            }).share();
+        }
+
+        // runs f on the calling thread, for subsystems that must stay on the main thread
+        void start_now(Subsystem subsystem, const std::function<void()>& f) {
+            std::promise<void> promise{};
+            ready[static_cast<std::size_t>(subsystem)] = promise.get_future().share();
+
+            const auto started = std::chrono::steady_clock::now();
+            f();
+            this->report_ready(subsystem, started);
+            promise.set_value();
+        }
+
         void raw_on_frame() const {
             try {
                 if (this->on_frame) {
@@ -177,28 +281,49 @@ namespace ff::sys {
             ) : params(params), on_frame(frame), on_error(err) {
             SYS_STDIO_Report(params & ContextParams::StdioReport);
 
+            // Filesystem, audio, graphics, system and input are brought up one after the other on this thread,
+            // in the order they always had: GRRLIB_Init() may mount the SD card again, and libfat, ASND, WPAD and
+            // VIDEO/GX init have not been shown to be safe alongside each other on hardware
             if (params & ContextParams::Filesystem) {
-                fatInitDefault();
+                this->start_now(Subsystem::Filesystem, []() {
+                    fatInitDefault();
+                });
             }
 
             if (params & ContextParams::Audio) {
-                ASND_Init();
+                this->start_now(Subsystem::Audio, []() {
+                    ff::audio::init();
+                });
             }
 
-            if ((params & ContextParams::Graphics))
-                GRRLIB_Init();
-            else
-                VIDEO_Init();
+            this->start_now(Subsystem::Graphics, [params]() {
+                if ((params & ContextParams::Graphics))
+                    GRRLIB_Init();
+                else
+                    VIDEO_Init();
+            });
 
-            WII_Initialize();
+            this->start_now(Subsystem::System, []() {
+                WII_Initialize();
+            });
 
             if (params & ContextParams::GenericInput) {
-                WPAD_Init();
-                WPAD_SetVRes(0, 640, 480);
+                this->start_now(Subsystem::Input, [params]() {
+                    WPAD_Init();
+                    WPAD_SetVRes(WPAD_CHAN_ALL, 640, 480);
 
-                if (params & ContextParams::IR) {
-                    WPAD_SetDataFormat(WPAD_CHAN_0, WPAD_FMT_BTNS_ACC_IR);
-                }
+                    if (params & ContextParams::IR) {
+                        WPAD_SetDataFormat(WPAD_CHAN_ALL, WPAD_FMT_BTNS_ACC_IR);
+                    }
+                });
+            }
+
+            // only networking runs in the background: DHCP can take seconds and net_init() shares no state
+            // with the subsystems above, which are all up by now; use wait_ready()/is_ready() before using it
+            if (params & ContextParams::Network) {
+                this->start_async(Subsystem::Network, []() {
+                    ff::net::init();
+                });
             }
 
             if (!(params & ContextParams::Console)) {
@@ -234,6 +359,23 @@ namespace ff::sys {
             throw std::runtime_error{"WII_LaunchTitle() failed; this likely means that the title is not installed on the console."};
         }
 
+        // future that becomes ready once the subsystem is initialized, and holds any exception it threw
+        [[nodiscard]] std::shared_future<void> get_ready(Subsystem subsystem) const {
+            const auto& future = ready.at(static_cast<std::size_t>(subsystem));
+            if (!future.valid()) {
+                throw std::runtime_error{std::string{"subsystem was not requested: "} + subsystem_name(subsystem)};
+            }
+            return future;
+        }
+        [[nodiscard]] bool is_ready(Subsystem subsystem) const noexcept {
+            const auto& future = ready.at(static_cast<std::size_t>(subsystem));
+            return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+        // blocks until the subsystem is initialized, rethrows if initialization failed
+        void wait_ready(Subsystem subsystem) const {
+            this->get_ready(subsystem).get();
+        }
+
         [[nodiscard]] ScreenDimensions get_screen_dimensions() const noexcept {
             return screen_dimensions;
         }
@@ -245,21 +387,77 @@ namespace ff::sys {
 
             return buttons;
         }
-        IR& get_ir() {
+        IR& get_ir(int channel = 0) {
             if (!(params & ContextParams::GenericInput)) {
                 throw std::runtime_error{"ContextParams::GenericInput is not set, cannot get IR"};
             }
 
-            return ir;
+            return ir.at(channel);
+        }
+        // every button transition on every channel since the previous poll(), oldest first
+        [[nodiscard]] const std::vector<ff::input::Event>& get_events() const {
+            if (!(params & ContextParams::GenericInput)) {
+                throw std::runtime_error{"ContextParams::GenericInput is not set, cannot get events"};
+            }
+
+            return events;
         }
         void poll() {
-            if (this->params & ContextParams::GenericInput) {
-                WPAD_ScanPads();
+            // the sampler is started on the first poll() once input is up
+            if (!this->input_ready) {
+                this->input_ready = this->is_ready(Subsystem::Input);
+                if (!this->input_ready) {
+                    return;
+                }
+                if (this->params & ContextParams::InputThread) {
+                    this->sampler = std::make_unique<ff::input::Sampler>(this->params & ContextParams::IR);
+                }
+            }
+
+            this->events.clear();
+            this->buttons.pressed.fill(0);
+            this->buttons.up.fill(0);
+
+            if (this->sampler) {
+                this->sampler->drain(this->events);
+                for (const auto& e : this->events) {
+                    if (e.type == ff::input::EventType::Press) {
+                        this->buttons.pressed[e.channel] |= e.button;
+                    } else {
+                        this->buttons.up[e.channel] |= e.button;
+                    }
+                }
+                for (int ch = 0; ch < ff::input::channel_count; ++ch) {
+                    this->buttons.held[ch] = this->sampler->get_held(ch);
+                }
+                if (this->params & ContextParams::IR) {
+                    for (int ch = 0; ch < ff::input::channel_count; ++ch) {
+                        const auto s = this->sampler->get_ir(ch);
+                        this->ir[ch].assign_values(s.x, s.y, s.angle, s.valid);
+                    }
+                }
+                return;
             }
-            if (this->params & ContextParams::IR) {
-                ir_t r_ir{};
-                WPAD_IR(0, &r_ir);
-                this->ir.assign_values(r_ir.x, r_ir.y, r_ir.angle, r_ir.valid);
+
+            WPAD_ScanPads();
+            const auto now = std::chrono::steady_clock::now();
+            for (int ch = 0; ch < ff::input::channel_count; ++ch) {
+                this->buttons.pressed[ch] = WPAD_ButtonsDown(ch);
+                this->buttons.held[ch] = WPAD_ButtonsHeld(ch);
+                this->buttons.up[ch] = WPAD_ButtonsUp(ch);
+
+                ff::input::for_each_bit(this->buttons.pressed[ch], [&](std::uint32_t bit) {
+                    this->events.push_back(ff::input::Event{.channel = ch, .type = ff::input::EventType::Press, .button = bit, .timestamp = now});
+                });
+                ff::input::for_each_bit(this->buttons.up[ch], [&](std::uint32_t bit) {
+                    this->events.push_back(ff::input::Event{.channel = ch, .type = ff::input::EventType::Release, .button = bit, .timestamp = now});
+                });
+
+                if (this->params & ContextParams::IR) {
+                    ir_t r_ir{};
+                    WPAD_IR(ch, &r_ir);
+                    this->ir[ch].assign_values(r_ir.x, r_ir.y, r_ir.angle, r_ir.valid);
+                }
             }
         }
 
@@ -275,6 +473,12 @@ namespace ff::sys {
         Context& operator=(Context&&) = delete;
 
         static void exit(ShutdownType type = ShutdownType::ReturnToMenu) noexcept {
+            // ~Context does not run on this path; the input thread must not touch WPAD while the system resets
+            try {
+                ff::input::Sampler::stop_active();
+            } catch (const std::exception&) {
+            }
+
             switch (type) {
                 case ShutdownType::ReturnToMenu:
                     SYS_ResetSystem(SYS_RETURNTOMENU, 0, 0);
@@ -300,6 +504,18 @@ namespace ff::sys {
         }
 
         ~Context() {
+            // never tear down a subsystem that is still being brought up
+            for (const auto& future : ready) {
+                if (future.valid()) {
+                    future.wait();
+                }
+            }
+            // stop sampling before WPAD goes away
+            this->sampler.reset();
+            if (params & ContextParams::MemoryReport) {
+                ff::mem::report();
+                ff::mem::report_leaks();
+            }
             if (params & ContextParams::Graphics) {
                 GRRLIB_Exit();
             }
@@ -309,6 +525,15 @@ namespace ff::sys {
             if (params & ContextParams::Audio) {
                 ASND_End();
             }
+            // only undo net_init() if it actually succeeded
+            const auto& network = ready[static_cast<std::size_t>(Subsystem::Network)];
+            if (network.valid()) {
+                try {
+                    network.get();
+                    net_deinit();
+                } catch (const std::exception&) {
+                }
+            }
         }
     };
 }
\ No newline at end of file
@@ -1,12 +1,12 @@
 #include <iostream>
 #include <chrono>
-#include <nlohmann/json.hpp>
 
 #include <net.hpp>
 #include <img.hpp>
 #include <ttf.hpp>
 #include <sys.hpp>
 #include <audio.hpp>
+#include <json.hpp>
 
 #include <font.ttf.hpp>
 #include <pointer.png.hpp>
@@ -14,7 +14,7 @@
 
 int main() {
     ff::sys::Context ctx{
-        ff::sys::ContextParams::Graphics | ff::sys::ContextParams::ControllerInput | ff::sys::ContextParams::IR | ff::sys::ContextParams::Filesystem | ff::sys::ContextParams::Audio,
+        ff::sys::ContextParams::Graphics | ff::sys::ContextParams::ControllerInput | ff::sys::ContextParams::IR | ff::sys::ContextParams::Filesystem | ff::sys::ContextParams::Audio | ff::sys::ContextParams::BootTiming | ff::sys::ContextParams::InputThread,
         [&ctx]() {
             ff::ttf::TextHandler<std::uint8_t, ::font_ttf.size()> ttf_ctx(::font_ttf);
             ff::img::ImageHandler<std::uint8_t, ::pointer_png.size()> pointer_drawable(::pointer_png, ff::img::ImageFormat::PNG);
@@ -25,7 +25,7 @@ int main() {
             while (true) {
                 ctx.poll();
 
-                if (ctx.get_buttons().get_pressed() == ff::sys::ControllerButton::ButtonHome) {
+                if (ctx.get_buttons().is_pressed(ff::sys::ControllerButton::ButtonHome)) {
                     //ff::sys::Context::exit(ff::sys::ShutdownType::ReturnToMenu);
                     ff::sys::Context::exit(ff::sys::ShutdownType::ReturnToLoader);
                     return EXIT_FAILURE; // unreachable anyway
@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <catalog.hpp>
+
+// Host tests for ff::catalog::VirtualGrid.
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAIL %s\n", what);
+        ++failures;
+    }
+}
+
+struct Row {
+    std::size_t index{static_cast<std::size_t>(-1)};
+};
+
+static constexpr ff::catalog::Rect viewport{.x = 0, .y = 0, .width = 640, .height = 480};
+static constexpr ff::catalog::GridLayout layout{.item_width = 128, .item_height = 96, .spacing = 8, .columns = 0, .prefetch_rows = 2};
+
+// every visible row must be bound to the index it is drawn for, and every drawn rect must intersect the viewport
+static bool visible_rows_bound(ff::catalog::VirtualGrid<Row>& grid) {
+    bool ok = true;
+    grid.for_each_visible([&](const Row& row, std::size_t index, const ff::catalog::Rect& rect) {
+        ok = ok && row.index == index && rect.y + rect.height > viewport.y && rect.y < viewport.y + viewport.height;
+    });
+    return ok;
+}
+
+static void test_pool_size_is_independent_of_item_count() {
+    std::size_t expected = 0;
+    for (const std::size_t count : {100, 1000, 10000, 100000, 1000000}) {
+        std::size_t binds = 0;
+        ff::catalog::VirtualGrid<Row> grid{viewport, layout, [&](Row& row, std::size_t index) {
+            row.index = index;
+            ++binds;
+        }};
+        grid.set_item_count(count);
+        grid.scroll_to(grid.get_max_scroll() / 2);
+        grid.update();
+
+        if (!expected) {
+            expected = grid.get_pool_size();
+        }
+        expect(grid.get_pool_size() == expected, "pool size does not depend on the item count");
+        expect(binds <= grid.get_pool_size(), "one update binds at most one screenful");
+    }
+}
+
+static void test_scrolling_keeps_rows_bound() {
+    ff::catalog::VirtualGrid<Row> grid{viewport, layout, [](Row& row, std::size_t index) {
+        row.index = index;
+    }};
+    grid.set_item_count(100000);
+
+    std::srand(1);
+    for (int frame = 0; frame < 5000; ++frame) {
+        switch (std::rand() % 4) {
+            case 0: grid.scroll_by(std::rand() % 97); break;
+            case 1: grid.scroll_by(-(std::rand() % 97)); break;
+            case 2: grid.scroll_to(std::rand() % (grid.get_max_scroll() + 1)); break;
+            default: grid.scroll_to_item(static_cast<std::size_t>(std::rand()) % grid.get_item_count()); break;
+        }
+        grid.update();
+        if (!visible_rows_bound(grid)) {
+            expect(false, "every visible row is bound to its own index after scrolling");
+            break;
+        }
+    }
+
+    grid.scroll_to(grid.get_max_scroll());
+    grid.update();
+    expect(grid.get_visible().last == grid.get_item_count(), "the last item is visible at the end");
+    grid.scroll_to(0);
+    grid.update();
+    expect(grid.get_visible().first == 0, "the first item is visible at the top");
+
+    grid.scroll_to_item(5000);
+    grid.update();
+    expect(grid.get_visible().contains(5000), "scroll_to_item() brings the item into view");
+
+    // a relayout must not leave stale visible rows behind
+    grid.set_layout({.item_width = 128, .item_height = 96, .spacing = 8, .columns = 1, .prefetch_rows = 2});
+    expect(grid.get_visible().empty(), "nothing is visible between set_layout() and update()");
+    grid.update();
+    expect(visible_rows_bound(grid), "rows are rebound after set_layout()");
+}
+
+static void test_request_and_evict_balance() {
+    std::set<std::size_t> loaded{};
+    std::size_t requests = 0;
+    std::size_t evictions = 0;
+    bool duplicate = false;
+    bool unknown = false;
+
+    ff::catalog::VirtualGrid<Row> grid{viewport, layout,
+        [](Row& row, std::size_t index) {
+            row.index = index;
+        },
+        [&](std::size_t index) {
+            duplicate = duplicate || !loaded.insert(index).second;
+            ++requests;
+        },
+        [&](std::size_t index) {
+            unknown = unknown || !loaded.erase(index);
+            ++evictions;
+        }};
+    grid.set_item_count(100000);
+
+    std::srand(2);
+    for (int frame = 0; frame < 2000; ++frame) {
+        grid.scroll_by(std::rand() % 400 - 150);
+        grid.update();
+        expect(loaded.size() == grid.get_prefetched().size(), "exactly the prefetch range is loaded");
+    }
+    expect(!duplicate, "no item is requested twice without an evict in between");
+    expect(!unknown, "only requested items are evicted");
+
+    grid.set_item_count(10);
+    expect(loaded.empty(), "replacing the catalog evicts everything");
+    expect(requests == evictions, "requests and evictions balance");
+}
+
+static void test_hit_test() {
+    ff::catalog::VirtualGrid<Row> grid{viewport, layout, [](Row& row, std::size_t index) {
+        row.index = index;
+    }};
+    grid.set_item_count(6);
+    grid.update();
+
+    // 640 px fits 4 columns of 128 + 8
+    expect(grid.get_columns() == 4, "four columns fit");
+    expect(grid.hit_test(10, 10) == std::optional<std::size_t>{0}, "first item");
+    expect(grid.hit_test(140, 10) == std::optional<std::size_t>{1}, "second item");
+    expect(grid.hit_test(140, 110) == std::optional<std::size_t>{5}, "item on the second row");
+    expect(!grid.hit_test(130, 10), "horizontal gap between items");
+    expect(!grid.hit_test(10, 100), "vertical gap between rows");
+    expect(!grid.hit_test(300, 110), "past the last item on the last row");
+    expect(!grid.hit_test(10, 300), "below the last row");
+    expect(!grid.hit_test(600, 10), "right of the last column");
+    expect(!grid.hit_test(-1, 10), "outside the viewport");
+}
+
+int main() {
+    test_pool_size_is_independent_of_item_count();
+    test_scrolling_keeps_rows_bound();
+    test_request_and_evict_balance();
+    test_hit_test();
+
+    if (failures) {
+        std::printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    std::printf("all catalog tests passed\n");
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <hash.hpp>
+
+// Host throughput of the ff::hash kernels, fed in 1 KiB pieces like a socket read.
+// Usage: hash_bench [megabytes]; configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+template <typename H>
+static void bench(const char* name, const std::vector<std::uint8_t>& data) {
+    constexpr std::size_t piece = 1024;
+
+    H h{};
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < data.size(); i += piece) {
+        h.update(data.data() + i, std::min(piece, data.size() - i));
+    }
+    const auto digest = h.finish();
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-8s %9.1f MB/s  %s\n", name, static_cast<double>(data.size()) / seconds / 1e6, ff::hash::to_hex(digest).c_str());
+}
+
+int main(int argc, char** argv) {
+    const auto megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+
+    std::vector<std::uint8_t> data(megabytes << 20);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>(i * 2654435761u >> 24);
+    }
+
+    bench<ff::hash::Crc32>("crc32", data);
+    bench<ff::hash::Sha1>("sha1", data);
+    bench<ff::hash::Sha256>("sha256", data);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <string>
+#include <hash.hpp>
+
+// Known-answer tests for ff::hash (FIPS 180 vectors and the CRC-32 check value),
+// each input also fed in 1 byte and odd-sized pieces to exercise the block buffering.
+
+static int failures = 0;
+
+template <typename H>
+static std::string hash_in_pieces(const std::string& input, std::size_t piece) {
+    H h{};
+    for (std::size_t i = 0; i < input.size(); i += piece) {
+        h.update(input.data() + i, std::min(piece, input.size() - i));
+    }
+    return ff::hash::to_hex(h.finish());
+}
+
+template <typename H>
+static void check(const char* name, const std::string& input, const char* expected) {
+    for (const std::size_t piece : {input.size() ? input.size() : 1, std::size_t{1}, std::size_t{7}, std::size_t{63}, std::size_t{65}, std::size_t{1000}}) {
+        const auto actual = hash_in_pieces<H>(input, piece);
+        if (actual != expected) {
+            std::printf("FAIL %s (%zu byte pieces): expected %s, got %s\n", name, piece, expected, actual.c_str());
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    const std::string empty{};
+    const std::string abc{"abc"};
+    const std::string msg448{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+    const std::string million_a(1000000, 'a');
+
+    check<ff::hash::Sha1>("sha1 \"\"", empty, "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    check<ff::hash::Sha1>("sha1 abc", abc, "a9993e364706816aba3e25717850c26c9cd0d89d");
+    check<ff::hash::Sha1>("sha1 448 bit", msg448, "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    check<ff::hash::Sha1>("sha1 million a", million_a, "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+    check<ff::hash::Sha256>("sha256 \"\"", empty, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    check<ff::hash::Sha256>("sha256 abc", abc, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    check<ff::hash::Sha256>("sha256 448 bit", msg448, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    check<ff::hash::Sha256>("sha256 million a", million_a, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    check<ff::hash::Crc32>("crc32 check", std::string{"123456789"}, "cbf43926");
+    check<ff::hash::Crc32>("crc32 \"\"", empty, "00000000");
+    check<ff::hash::Crc32>("crc32 million a", million_a, "dc25bfbc");
+
+    // a hasher is reusable after finish()
+    ff::hash::Sha256 reused{};
+    reused.update("garbage", 7);
+    static_cast<void>(reused.finish());
+    reused.update(abc.data(), abc.size());
+    if (ff::hash::to_hex(reused.finish()) != "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") {
+        std::printf("FAIL sha256 reuse after finish()\n");
+        ++failures;
+    }
+
+    auto good = ff::hash::Verifier::from_hex("A9993E364706816ABA3E25717850C26C9CD0D89D");
+    good.update(abc.data(), abc.size());
+    if (!good.matches()) {
+        std::printf("FAIL verifier rejected a matching sha1\n");
+        ++failures;
+    }
+
+    auto bad = ff::hash::Verifier::from_hex("cbf43927");
+    bad.update("123456789", 9);
+    try {
+        bad.verify();
+        std::printf("FAIL verifier accepted a mismatching crc32\n");
+        ++failures;
+    } catch (const std::runtime_error&) {
+    }
+
+    if (failures) {
+        std::printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    std::printf("all hash tests passed\n");
+    return 0;
+}